@@ -0,0 +1,649 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Storage of CompactVector.
+// HeapHeader == false: element pointer + 32-bit size + 32-bit capacity (16 bytes on 64-bit systems).
+// HeapHeader == true: a single pointer to a heap block that starts with the 32-bit size and capacity,
+// followed by the elements (8 bytes on 64-bit systems). An empty vector holds no block.
+template<class T, bool HeapHeader>
+class CompactStorage;
+
+template<class T>
+class CompactStorage<T, false> {
+public:
+    T* elements() const noexcept {
+        return first;
+    }
+
+    uint32_t size() const noexcept {
+        return count;
+    }
+
+    uint32_t capacity() const noexcept {
+        return limit;
+    }
+
+    void set_size(uint32_t size) noexcept {
+        count = size;
+    }
+
+    // Allocates room for `capacity` elements, without installing it.
+    static T* allocate(uint32_t capacity) {
+        return capacity ? std::allocator<T>().allocate(capacity) : nullptr;
+    }
+
+    static void deallocate(T* elements, uint32_t capacity) noexcept {
+        if (elements) {
+            std::allocator<T>().deallocate(elements, capacity);
+        }
+    }
+
+    // Replaces the current storage (which must not hold constructed elements anymore).
+    void install(T* elements, uint32_t size, uint32_t capacity) noexcept {
+        deallocate(first, limit);
+        first = elements;
+        count = size;
+        limit = capacity;
+    }
+
+    void swap(CompactStorage& x) noexcept {
+        std::swap(first, x.first);
+        std::swap(count, x.count);
+        std::swap(limit, x.limit);
+    }
+
+private:
+    T* first = nullptr;
+    uint32_t count = 0;
+    uint32_t limit = 0;
+};
+
+template<class T>
+class CompactStorage<T, true> {
+    struct Header {
+        uint32_t size;
+        uint32_t capacity;
+    };
+
+    // Offset of the first element from the start of the block.
+    static constexpr std::size_t OFFSET = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "over-aligned element types are not supported");
+
+    static Header* header_of(T* elements) noexcept {
+        return reinterpret_cast<Header*>(reinterpret_cast<char*>(elements) - OFFSET);
+    }
+
+public:
+    T* elements() const noexcept {
+        return block ? reinterpret_cast<T*>(reinterpret_cast<char*>(block) + OFFSET) : nullptr;
+    }
+
+    uint32_t size() const noexcept {
+        return block ? block->size : 0;
+    }
+
+    uint32_t capacity() const noexcept {
+        return block ? block->capacity : 0;
+    }
+
+    void set_size(uint32_t size) noexcept {
+        if (block) {
+            block->size = size;
+        }
+    }
+
+    static T* allocate(uint32_t capacity) {
+        if (capacity == 0) {
+            return nullptr;
+        }
+        Header* header = static_cast<Header*>(::operator new(OFFSET + std::size_t(capacity) * sizeof(T)));
+        header->size = 0;
+        header->capacity = capacity;
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(header) + OFFSET);
+    }
+
+    static void deallocate(T* elements, uint32_t) noexcept {
+        if (elements) {
+            ::operator delete(header_of(elements));
+        }
+    }
+
+    void install(T* elements, uint32_t size, uint32_t) noexcept {
+        if (block) {
+            ::operator delete(block);
+        }
+        block = elements ? header_of(elements) : nullptr;
+        set_size(size);
+    }
+
+    void swap(CompactStorage& x) noexcept {
+        std::swap(block, x.block);
+    }
+
+private:
+    Header* block = nullptr;
+};
+
+// Vector with a compact object header for large numbers of small vectors.
+// Size and capacity are 32-bit; with HeapHeader (the default) they live in the heap block
+// next to the elements, so the object itself is a single pointer. Same API as Vector.
+template<class T, bool HeapHeader = true>
+class CompactVector {
+public:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef T value_type;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    // CONSTRUCTOR
+
+    // 1. empty container constructor (default constructor)
+    // Constructs an empty container, with no elements. Nothing is allocated.
+    CompactVector() noexcept {}
+
+    // 2. fill constructor
+    // Constructs a container with `size` elements. Each element is a copy of `value`.
+    explicit CompactVector(size_type size, const T& value) {
+        assign(size, value);
+    }
+
+    // 3. range constructor
+    // Constructs a container with a copy of each element in the range [first, last), in the same order.
+    // The capacity is exactly the size for forward iterators.
+    template<class InputIterator, class = std::enable_if_t<!std::is_integral<InputIterator>::value>>
+    CompactVector(InputIterator first, InputIterator last) {
+        assign(first, last);
+    }
+
+    // 4. copy constructor
+    // Constructs a container with a copy of each of the elements in vector, with capacity equal to its size.
+    CompactVector(const CompactVector& vector) {
+        assign(vector.begin(), vector.end());
+    }
+
+    // 5. move constructor
+    // Takes the storage of vector, which is left empty.
+    CompactVector(CompactVector&& vector) noexcept {
+        storage.swap(vector.storage);
+    }
+
+    // 6. initializer list constructor
+    // Constructs a container with a copy of each of the elements in il, in the same order.
+    CompactVector(const std::initializer_list<T>& il) {
+        assign(il.begin(), il.end());
+    }
+
+    // 7. size constructor
+    // Constructs a container with n value-initialized elements.
+    explicit CompactVector(size_type n) {
+        resize(n);
+    }
+
+
+
+    // DESTRUCTOR
+
+    // Destroys the elements and frees the storage.
+    ~CompactVector() {
+        clear();
+        storage.install(nullptr, 0, 0);
+    }
+
+
+
+    // OPERATOR =
+
+    // 1. Copy assignment
+    // Copies all the elements from x into the container (with x preserving its contents).
+    CompactVector& operator=(const CompactVector& x) {
+        if (this != &x) {
+            assign(x.begin(), x.end());
+        }
+
+        return *this;
+    }
+
+    // 2. Move assignment
+    // Takes the storage of x, which is left empty.
+    CompactVector& operator=(CompactVector&& x) noexcept {
+        if (this != &x) {
+            clear();
+            storage.install(nullptr, 0, 0);
+            storage.swap(x.storage);
+        }
+
+        return *this;
+    }
+
+
+
+    // ITERATORS
+
+    // Return iterator to beginning
+    // Returns an iterator pointing to the first element in the vector.
+    iterator begin() noexcept {
+        return storage.elements();
+    }
+
+    const_iterator begin() const noexcept {
+        return storage.elements();
+    }
+
+    // Return const_iterator to beginning
+    // Returns a const_iterator pointing to the first element in the container.
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    // Return const_iterator to end
+    // Returns a const_iterator pointing to the past-the-end element in the container.
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Return const_reverse_iterator to reverse beginning
+    // Returns a const_reverse_iterator pointing to the last element in the container.
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    // Return const_reverse_iterator to reverse end
+    // Returns a const_reverse_iterator pointing to the theoretical element preceding the first element.
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
+    // Return iterator to end
+    // Returns an iterator referring to the past-the-end element in the vector container.
+    iterator end() noexcept {
+        return storage.elements() + storage.size();
+    }
+
+    const_iterator end() const noexcept {
+        return storage.elements() + storage.size();
+    }
+
+    // Return reverse iterator to reverse beginning
+    // Returns a reverse iterator pointing to the last element in the vector.
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    // Return reverse iterator to reverse end
+    // Returns a reverse iterator pointing to the theoretical element preceding the first element.
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+
+
+    // CAPACITY
+
+    // Return size
+    // Returns the number of elements in the vector.
+    size_type size() const noexcept {
+        return storage.size();
+    }
+
+    // Return maximum size
+    // Returns the maximum number of elements the vector can hold: 2^32 - 1, the limit of the 32-bit counters.
+    size_type max_size() const noexcept {
+        return std::numeric_limits<uint32_t>::max();
+    }
+
+    // Change size
+    // Resizes the container so that it contains n elements. New elements are value-initialized
+    // (or copies of value), unlike Vector::resize, which leaves them unconstructed.
+    void resize(size_type n) {
+        if (n < size()) {
+            std::destroy(begin() + n, end());
+            storage.set_size(uint32_t(n));
+        }
+        else if (n > size()) {
+            reserve(n);
+            std::uninitialized_value_construct(end(), begin() + n);
+            storage.set_size(uint32_t(n));
+        }
+    }
+
+    void resize(size_type n, const value_type& value) {
+        if (n < size()) {
+            resize(n);
+        }
+        else if (n > capacity()) {
+            // value may refer to an element of the vector, so it is copied out before a reallocation.
+            T copy(value);
+            reserve(n);
+            std::uninitialized_fill(end(), begin() + n, copy);
+            storage.set_size(uint32_t(n));
+        }
+        else if (n > size()) {
+            std::uninitialized_fill(end(), begin() + n, value);
+            storage.set_size(uint32_t(n));
+        }
+    }
+
+    // Return size of allocated storage capacity
+    // Returns the number of elements the current storage can hold.
+    size_type capacity() const noexcept {
+        return storage.capacity();
+    }
+
+    // Test whether vector is empty
+    // Returns whether the vector is empty (i.e. whether its size is 0).
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // Request a change in capacity
+    // Reallocates to exactly n elements if n exceeds the capacity. Throws std::length_error if n does not fit the 32-bit capacity.
+    void reserve(size_type n) {
+        if (n > capacity()) {
+            reallocate(n);
+        }
+    }
+
+    // Shrink to fit
+    // Reallocates the storage to fit the size exactly (an empty vector frees it).
+    void shrink_to_fit() {
+        if (capacity() > size()) {
+            reallocate(size());
+        }
+    }
+
+
+
+    // ELEMENT ACCESS
+
+    // Access element with operator[]
+    // Returns a reference to the element at position n in the vector container (unchecked).
+    T& operator[](size_type n) {
+        return begin()[n];
+    }
+
+    const T& operator[](size_type n) const {
+        return begin()[n];
+    }
+
+    // Access element with at()
+    // Returns a reference to the element at position n. Throws std::out_of_range if n >= size().
+    reference at(size_type n) {
+        if (n >= size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return begin()[n];
+    }
+
+    const_reference at(size_type n) const {
+        if (n >= size()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return begin()[n];
+    }
+
+    // Access first element
+    // Returns a reference to the first element in the vector.
+    reference front() {
+        return begin()[0];
+    }
+
+    const_reference front() const {
+        return begin()[0];
+    }
+
+    // Access last element
+    // Returns a reference to the last element in the vector.
+    reference back() {
+        return begin()[size() - 1];
+    }
+
+    const_reference back() const {
+        return begin()[size() - 1];
+    }
+
+    // Access data
+    // Returns a direct pointer to the elements (nullptr while nothing is allocated).
+    value_type* _data() noexcept {
+        return begin();
+    }
+
+    const value_type* _data() const noexcept {
+        return begin();
+    }
+
+
+
+    // MODIFIERS
+
+    // Assign vector content
+    // Assigns new contents to the vector, replacing its current contents, and modifying its size accordingly.
+
+    // 1. Range assign
+    // The new contents are copies of the elements in [first, last), in the same order.
+    template<class InputIterator, class = std::enable_if_t<!std::is_integral<InputIterator>::value>>
+    void assign(InputIterator first, InputIterator last) {
+        clear();
+        typedef typename std::iterator_traits<InputIterator>::iterator_category category;
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            reserve(std::distance(first, last));
+        }
+        for (; first != last; ++first) {
+            push_back(*first);
+        }
+    }
+
+    // 2. Fill assign
+    // The new contents are n elements, each initialized to a copy of val.
+    void assign(size_type n, const value_type& val) {
+        T copy(val); // val may be one of the elements destroyed by clear()
+        clear();
+        resize(n, copy);
+    }
+
+    // 3. Initializer list assign
+    // The new contents are copies of the values passed as initializer list, in the same order.
+    void assign(std::initializer_list<value_type> il) {
+        assign(il.begin(), il.end());
+    }
+
+    // Add element at the end
+    // Adds a copy (or moved) val after the current last element. Throws std::length_error at the 32-bit limit.
+    // val may refer to an element of the vector, so it is copied out before a reallocation.
+    void push_back(const value_type& val) {
+        if (size() == capacity()) {
+            T copy(val);
+            grow();
+            unchecked_append(std::move(copy));
+        }
+        else {
+            unchecked_append(val);
+        }
+    }
+
+    void push_back(value_type&& val) {
+        if (size() == capacity()) {
+            T moved(std::move(val));
+            grow();
+            unchecked_append(std::move(moved));
+        }
+        else {
+            unchecked_append(std::move(val));
+        }
+    }
+
+    // Delete last element
+    // Removes the last element in the vector, reducing the container size by one.
+    void pop_back() {
+        std::destroy_at(end() - 1);
+        storage.set_size(storage.size() - 1);
+    }
+
+    // Insert elements
+    // Inserts new elements before the element at position; position may be end(), which appends.
+    // Returns an iterator to the first inserted element. Throws std::out_of_range for other positions.
+
+    // 1. Single element insert
+    iterator insert(iterator position, const value_type& val) {
+        return insert(position, 1, val);
+    }
+
+    // 2. Fill insert
+    iterator insert(iterator position, size_type n, const value_type& val) {
+        if (position < begin() || position > end()) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        // val may refer to an element that is moved by the insertion.
+        size_type index = position - begin();
+        T copy(val);
+        if (size() + n > capacity()) {
+            grow(size() + n);
+        }
+        return fill_gap(index, n, copy);
+    }
+
+    // Erase elements
+    // Removes from the vector either a single element (position) or a range of elements ([first,last)).
+    // Returns an iterator to the element that followed the erased ones.
+
+    iterator erase(iterator position) {
+        if (position < begin() || position >= end()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return erase(position, position + 1);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        iterator new_end = std::move(last, end(), first);
+        std::destroy(new_end, end());
+        storage.set_size(uint32_t(new_end - begin()));
+        return first;
+    }
+
+    // Swap content
+    // Exchanges the content of the container by the content of x. Sizes may differ.
+    void swap(CompactVector& x) noexcept {
+        storage.swap(x.storage);
+    }
+
+    // Clear content
+    // Removes all elements from the vector (which are destroyed), leaving the container with a size of 0.
+    // The capacity is kept, like Vector::clear(); call shrink_to_fit() to free it.
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        storage.set_size(0);
+    }
+
+
+
+    // NON-MEMBER FUNCTION OVERLOADS
+
+    // Relational operators for vector
+    // Performs the appropriate comparison operation between the vector containers and rhs.
+
+    bool operator==(const CompactVector& rhs) const {
+        return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+    }
+
+    bool operator!=(const CompactVector& rhs) const {
+        return !(*this == rhs);
+    }
+
+    bool operator<(const CompactVector& rhs) const {
+        return std::lexicographical_compare(begin(), end(), rhs.begin(), rhs.end());
+    }
+
+    bool operator>(const CompactVector& rhs) const {
+        return rhs < *this;
+    }
+
+    bool operator>=(const CompactVector& rhs) const {
+        return !(*this < rhs);
+    }
+
+    bool operator<=(const CompactVector& rhs) const {
+        return !(*this > rhs);
+    }
+
+private:
+    CompactStorage<T, HeapHeader> storage;
+
+    // Throws std::length_error if the vector cannot grow to new_capacity within 32 bits.
+    void grow(size_type new_capacity = 1) {
+        if (capacity() == max_size() || new_capacity > max_size()) {
+            throw std::length_error("CompactVector capacity exceeds 32 bits");
+        }
+        reallocate(std::min<size_type>(std::max<size_type>(2 * capacity(), new_capacity), max_size()));
+    }
+
+    template<class U>
+    void unchecked_append(U&& val) {
+        ::new (static_cast<void*>(end())) T(std::forward<U>(val));
+        storage.set_size(storage.size() + 1);
+    }
+
+    // Moves the elements to new storage of exactly new_capacity (>= size()) elements.
+    void reallocate(size_type new_capacity) {
+        if (new_capacity > max_size()) {
+            throw std::length_error("CompactVector capacity exceeds 32 bits");
+        }
+
+        uint32_t count = storage.size();
+        T* new_elements = CompactStorage<T, HeapHeader>::allocate(uint32_t(new_capacity));
+        try {
+            std::uninitialized_move(begin(), end(), new_elements);
+        }
+        catch (...) {
+            CompactStorage<T, HeapHeader>::deallocate(new_elements, uint32_t(new_capacity));
+            throw;
+        }
+
+        std::destroy(begin(), end());
+        storage.install(new_elements, count, uint32_t(new_capacity));
+    }
+
+    // Opens a gap of n elements at index (capacity must suffice) and fills it with val.
+    iterator fill_gap(size_type index, size_type n, const value_type& val) {
+        iterator position = begin() + index;
+        iterator old_end = end();
+        size_type after = old_end - position;
+
+        if (n < after) {
+            std::uninitialized_move(old_end - n, old_end, old_end);
+            std::move_backward(position, old_end - n, old_end);
+            std::fill(position, position + n, val);
+        }
+        else {
+            std::uninitialized_fill(old_end, position + n, val);
+            std::uninitialized_move(position, old_end, position + n);
+            std::fill(position, old_end, val);
+        }
+
+        storage.set_size(uint32_t(size() + n));
+        return position;
+    }
+};
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+
+// Parallel algorithms over Vector ranges (or the raw span returned by Vector::_data()).
+// The range is split into chunks whose boundaries fall on cache line boundaries of the written
+// memory, so two workers never write to the same cache line (for element sizes that do not divide
+// the line size this needs the range to start on a multiple of gcd(sizeof(T), 64) bytes, which
+// memory from Vector always does). Per-chunk results are kept in
+// cache-line-padded slots for the same reason.
+namespace parallel {
+
+    // Minimum amount of data processed by one task. Smaller chunks cost more in scheduling than
+    // they win in parallelism.
+    constexpr std::size_t MIN_CHUNK_BYTES = 16 * 1024;
+
+    // Number of chunks created per pool participant, so that faster workers can steal the rest.
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+    namespace detail {
+
+        template<class T>
+        struct alignas(CACHE_LINE_SIZE) Padded {
+            T value;
+        };
+
+        // Smallest number of elements that spans whole cache lines.
+        template<class T>
+        constexpr std::size_t elements_per_line() {
+            return std::lcm(CACHE_LINE_SIZE, sizeof(T)) / sizeof(T);
+        }
+
+        // Grain size heuristic
+        // Aims for CHUNKS_PER_THREAD chunks per participant, but never below MIN_CHUNK_BYTES,
+        // and rounds the result up to whole cache lines.
+        template<class T>
+        std::size_t grain_size(std::size_t n, std::size_t threads, std::size_t grain) {
+            const std::size_t line = elements_per_line<T>();
+            if (grain == 0) {
+                std::size_t target = threads * CHUNKS_PER_THREAD;
+                grain = std::max((n + target - 1) / target, MIN_CHUNK_BYTES / sizeof(T));
+            }
+            return std::max<std::size_t>(1, (grain + line - 1) / line) * line;
+        }
+
+        // Splits [0, n) of the memory starting at `first` into cache-line-aligned chunks.
+        template<class T>
+        class Chunks {
+        public:
+            Chunks(const T* first, std::size_t n, std::size_t threads, std::size_t grain) : n(n) {
+                this->grain = grain_size<T>(n, threads, grain);
+
+                // Elements before the first element that starts on a cache line boundary join the
+                // first chunk. Every later boundary is a whole number of lines further.
+                std::uintptr_t address = reinterpret_cast<std::uintptr_t>(first);
+                for (std::size_t i = 0; i < elements_per_line<T>(); i++) {
+                    if ((address + i * sizeof(T)) % CACHE_LINE_SIZE == 0) {
+                        head = i;
+                        break;
+                    }
+                }
+
+                if (n == 0) {
+                    chunks = 0;
+                }
+                else if (n <= head + this->grain) {
+                    chunks = 1;
+                }
+                else {
+                    chunks = (n - head + this->grain - 1) / this->grain;
+                }
+            }
+
+            std::size_t size() const noexcept {
+                return chunks;
+            }
+
+            std::size_t begin(std::size_t k) const noexcept {
+                return k == 0 ? 0 : head + k * grain;
+            }
+
+            std::size_t end(std::size_t k) const noexcept {
+                return k + 1 == chunks ? n : head + (k + 1) * grain;
+            }
+
+        private:
+            std::size_t n;
+            std::size_t grain = 1;
+            std::size_t head = 0;
+            std::size_t chunks = 0;
+        };
+
+        // Calls body(k, begin, end) for every chunk. A single chunk is run inline.
+        template<class T, class F>
+        void run_chunks(ThreadPool& pool, const Chunks<T>& chunks, F body) {
+            if (chunks.size() == 1) {
+                body(std::size_t(0), chunks.begin(0), chunks.end(0));
+                return;
+            }
+
+            TaskGroup group(pool);
+            for (std::size_t k = 0; k < chunks.size(); k++) {
+                group.run([&body, &chunks, k] {
+                    body(k, chunks.begin(k), chunks.end(k));
+                });
+            }
+            group.wait();
+        }
+    }
+
+    // parallel_for
+    // Calls f(element) for every element of [first, first + n).
+    template<class T, class F>
+    void parallel_for(ThreadPool& pool, T* first, std::size_t n, F f, std::size_t grain = 0) {
+        detail::Chunks<T> chunks(first, n, pool.size(), grain);
+        detail::run_chunks(pool, chunks, [first, &f](std::size_t, std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; i++) {
+                f(first[i]);
+            }
+        });
+    }
+
+    template<class T, class F>
+    void parallel_for(ThreadPool& pool, Vector<T>& vector, F f, std::size_t grain = 0) {
+        parallel_for(pool, vector._data(), vector.size(), f, grain);
+    }
+
+    // transform
+    // Stores f(in[i]) to out[i] for every element of [in, in + n). The ranges may be the same.
+    template<class T, class U, class F>
+    void transform(ThreadPool& pool, const T* in, std::size_t n, U* out, F f, std::size_t grain = 0) {
+        detail::Chunks<U> chunks(out, n, pool.size(), grain);
+        detail::run_chunks(pool, chunks, [in, out, &f](std::size_t, std::size_t b, std::size_t e) {
+            for (std::size_t i = b; i < e; i++) {
+                out[i] = f(in[i]);
+            }
+        });
+    }
+
+    // Output elements are assigned to, so [out, out + n) must hold constructed elements.
+    // The Vector overload fills `out` with in.size() default values first, unless it already has that size.
+    template<class T, class U, class F>
+    void transform(ThreadPool& pool, const Vector<T>& in, Vector<U>& out, F f, std::size_t grain = 0) {
+        if (out.size() != in.size()) {
+            out.assign(in.size(), U());
+        }
+        transform(pool, in._data(), in.size(), out._data(), f, grain);
+    }
+
+    // reduce
+    // Combines init and all elements of [first, first + n) with op. op must be associative;
+    // chunks are combined in order, so it does not have to be commutative.
+    template<class T, class Op>
+    T reduce(ThreadPool& pool, const T* first, std::size_t n, T init, Op op, std::size_t grain = 0) {
+        detail::Chunks<T> chunks(first, n, pool.size(), grain);
+        if (chunks.size() == 0) {
+            return init;
+        }
+
+        Vector<detail::Padded<T>> partials(chunks.size(), detail::Padded<T>{ init });
+        detail::run_chunks(pool, chunks, [first, &op, &partials](std::size_t k, std::size_t b, std::size_t e) {
+            T accumulator = first[b];
+            for (std::size_t i = b + 1; i < e; i++) {
+                accumulator = op(accumulator, first[i]);
+            }
+            partials[k].value = accumulator;
+        });
+
+        for (const detail::Padded<T>& partial : partials) {
+            init = op(init, partial.value);
+        }
+        return init;
+    }
+
+    template<class T, class Op>
+    T reduce(ThreadPool& pool, const Vector<T>& vector, T init, Op op, std::size_t grain = 0) {
+        return reduce(pool, vector._data(), vector.size(), init, op, grain);
+    }
+
+    template<class T>
+    T reduce(ThreadPool& pool, const Vector<T>& vector, T init = T()) {
+        return reduce(pool, vector, init, [](const T& a, const T& b) { return a + b; });
+    }
+
+    // inclusive_scan
+    // Stores in[0] op ... op in[i] to out[i]. Runs in two passes: the chunk totals are computed
+    // first, then every chunk is scanned starting from the total of the chunks before it.
+    template<class T, class Op>
+    void inclusive_scan(ThreadPool& pool, const T* in, std::size_t n, T* out, Op op, std::size_t grain = 0) {
+        detail::Chunks<T> chunks(out, n, pool.size(), grain);
+        if (chunks.size() == 0) {
+            return;
+        }
+
+        Vector<detail::Padded<T>> offsets(chunks.size(), detail::Padded<T>{ in[0] });
+        if (chunks.size() > 1) {
+            detail::run_chunks(pool, chunks, [in, &op, &offsets](std::size_t k, std::size_t b, std::size_t e) {
+                T accumulator = in[b];
+                for (std::size_t i = b + 1; i < e; i++) {
+                    accumulator = op(accumulator, in[i]);
+                }
+                offsets[k].value = accumulator;
+            });
+
+            // Turn the chunk totals into the offset of the next chunk.
+            for (std::size_t k = 1; k < offsets.size(); k++) {
+                offsets[k].value = op(offsets[k - 1].value, offsets[k].value);
+            }
+        }
+
+        detail::run_chunks(pool, chunks, [in, out, &op, &offsets](std::size_t k, std::size_t b, std::size_t e) {
+            T accumulator = k == 0 ? in[b] : op(offsets[k - 1].value, in[b]);
+            out[b] = accumulator;
+            for (std::size_t i = b + 1; i < e; i++) {
+                accumulator = op(accumulator, in[i]);
+                out[i] = accumulator;
+            }
+        });
+    }
+
+    // Fills `out` with in.size() default values first, unless it already has that size.
+    template<class T, class Op>
+    void inclusive_scan(ThreadPool& pool, const Vector<T>& in, Vector<T>& out, Op op, std::size_t grain = 0) {
+        if (out.size() != in.size()) {
+            out.assign(in.size(), T());
+        }
+        inclusive_scan(pool, in._data(), in.size(), out._data(), op, grain);
+    }
+
+    template<class T>
+    void inclusive_scan(ThreadPool& pool, const Vector<T>& in, Vector<T>& out) {
+        inclusive_scan(pool, in, out, [](const T& a, const T& b) { return a + b; });
+    }
+
+    // count_if
+    // Returns the number of elements of [first, first + n) for which pred returns true.
+    template<class T, class Pred>
+    std::size_t count_if(ThreadPool& pool, const T* first, std::size_t n, Pred pred, std::size_t grain = 0) {
+        detail::Chunks<T> chunks(first, n, pool.size(), grain);
+        Vector<detail::Padded<std::size_t>> counts(chunks.size(), detail::Padded<std::size_t>{ 0 });
+        detail::run_chunks(pool, chunks, [first, &pred, &counts](std::size_t k, std::size_t b, std::size_t e) {
+            std::size_t count = 0;
+            for (std::size_t i = b; i < e; i++) {
+                if (pred(first[i])) {
+                    count++;
+                }
+            }
+            counts[k].value = count;
+        });
+
+        std::size_t total = 0;
+        for (const detail::Padded<std::size_t>& count : counts) {
+            total += count.value;
+        }
+        return total;
+    }
+
+    template<class T, class Pred>
+    std::size_t count_if(ThreadPool& pool, const Vector<T>& vector, Pred pred, std::size_t grain = 0) {
+        return count_if(pool, vector._data(), vector.size(), pred, grain);
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+
+// RCU (read-copy-update) vector for one writer and many concurrent readers.
+// The contents are published as immutable Vector snapshots through an atomic pointer.
+// Readers pin the snapshot they read with an epoch stored in their own reader slot, which is
+// wait-free and does not allocate. The writer builds a new version (batching any number of
+// mutations), publishes it and frees old versions once no reader can still see them
+// (epoch-based reclamation).
+// Only one thread may call the writer methods (copy, publish, update, synchronize) at a time.
+template<class T>
+class RcuVector {
+    struct Version;
+    struct alignas(CACHE_LINE_SIZE) Slot;
+
+public:
+    typedef T value_type;
+    typedef size_t size_type;
+
+    class Reader;
+
+    // Snapshot
+    // Read access to the version that was current when it was taken. The version is kept
+    // alive for as long as the snapshot exists.
+    class Snapshot {
+    public:
+        typedef typename Vector<T>::const_iterator const_iterator;
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        ~Snapshot() {
+            reader.unlock();
+        }
+
+        const Vector<T>& operator*() const noexcept {
+            return version->data;
+        }
+
+        const Vector<T>* operator->() const noexcept {
+            return &version->data;
+        }
+
+        size_type size() const noexcept {
+            return version->data.size();
+        }
+
+        const T& operator[](size_type n) const {
+            return version->data[n];
+        }
+
+        const_iterator begin() const noexcept {
+            return version->data.begin();
+        }
+
+        const_iterator end() const noexcept {
+            return version->data.end();
+        }
+
+        // Number of the version (starts at 1 and grows with every publish).
+        uint64_t epoch() const noexcept {
+            return version->epoch;
+        }
+
+    private:
+        friend class Reader;
+
+        Reader& reader;
+        const Version* version;
+
+        explicit Snapshot(Reader& reader) : reader(reader), version(reader.lock()) {}
+    };
+
+    // Reader
+    // Registration of one reader thread. It owns a reader slot until it is destroyed.
+    // A Reader must only be used by one thread at a time; its snapshots may be nested.
+    class Reader {
+    public:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        ~Reader() {
+            slot.claimed.store(false, std::memory_order_release);
+        }
+
+        // Takes a snapshot of the current version.
+        Snapshot read() {
+            return Snapshot(*this);
+        }
+
+    private:
+        friend class RcuVector;
+        friend class Snapshot;
+
+        const RcuVector& owner;
+        Slot& slot;
+        const Version* version = nullptr;
+        size_type depth = 0;
+
+        Reader(const RcuVector& owner, Slot& slot) : owner(owner), slot(slot) {}
+
+        const Version* lock() noexcept {
+            if (depth++ == 0) {
+                slot.epoch.store(owner.epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+                version = owner.current.load(std::memory_order_seq_cst);
+            }
+            return version;
+        }
+
+        void unlock() noexcept {
+            if (--depth == 0) {
+                slot.epoch.store(IDLE, std::memory_order_release);
+            }
+        }
+    };
+
+    // CONSTRUCTOR
+
+    // Constructs an RcuVector holding `initial`, usable by at most `maxReaders` registered readers.
+    explicit RcuVector(const Vector<T>& initial = Vector<T>(), size_type maxReaders = 64)
+        : current(new Version(initial, 1)), slots(new Slot[maxReaders]), slotCount(maxReaders) {}
+
+    RcuVector(const RcuVector&) = delete;
+    RcuVector& operator=(const RcuVector&) = delete;
+
+    // DESTRUCTOR
+
+    // All Readers must be destroyed before the RcuVector.
+    ~RcuVector() {
+        delete current.load(std::memory_order_acquire);
+        while (retired) {
+            Version* next = retired->next;
+            delete retired;
+            retired = next;
+        }
+    }
+
+    // READERS
+
+    // Registers a reader. Throws std::runtime_error if all reader slots are taken.
+    Reader reader() {
+        for (size_type i = 0; i < slotCount; i++) {
+            Slot& slot = slots[i];
+            bool expected = false;
+            if (!slot.claimed.load(std::memory_order_relaxed)
+                && slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return Reader(*this, slot);
+            }
+        }
+        throw std::runtime_error("No free RcuVector reader slot");
+    }
+
+    // WRITER
+
+    // Returns a copy of the current version to be modified and published.
+    Vector<T> copy() const {
+        return current.load(std::memory_order_acquire)->data;
+    }
+
+    // Makes `next` the current version (its contents are taken, `next` is left empty) and
+    // frees the old versions that no reader can see anymore.
+    void publish(Vector<T>& next) {
+        uint64_t nextEpoch = epoch.load(std::memory_order_relaxed) + 1;
+        Version* version = new Version(Vector<T>(), nextEpoch);
+        version->data.swap(next);
+
+        Version* old = current.exchange(version, std::memory_order_seq_cst);
+        old->next = retired;
+        retired = old;
+        epoch.store(nextEpoch, std::memory_order_seq_cst);
+
+        reclaim();
+    }
+
+    // Applies f(Vector<T>&) to a copy of the current version and publishes the result,
+    // so that readers see all mutations made by f at once.
+    template<class F>
+    void update(F f) {
+        Vector<T> next = copy();
+        f(next);
+        publish(next);
+    }
+
+    // Waits until every old version is freed, i.e. until every reader has left the snapshots
+    // taken before the last publish.
+    void synchronize() {
+        while (!reclaim()) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Number of old versions that are not freed yet.
+    size_type retired_count() const noexcept {
+        size_type count = 0;
+        for (Version* it = retired; it; it = it->next) {
+            count++;
+        }
+        return count;
+    }
+
+private:
+    // Reader epoch of a slot outside of any snapshot.
+    static constexpr uint64_t IDLE = std::numeric_limits<uint64_t>::max();
+
+    struct Version {
+        Vector<T> data;
+        uint64_t epoch;
+        Version* next = nullptr;
+
+        Version(const Vector<T>& data, uint64_t epoch) : data(data), epoch(epoch) {}
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> epoch{ IDLE };
+        std::atomic<bool> claimed{ false };
+    };
+
+    std::atomic<Version*> current;
+    std::atomic<uint64_t> epoch{ 1 };
+    std::unique_ptr<Slot[]> slots;
+    size_type slotCount;
+    Version* retired = nullptr; // newest first, owned by the writer
+
+    // Frees the retired versions older than the oldest epoch a reader is in.
+    // A version retired at epoch e can only be seen by readers that entered at an epoch <= e.
+    // Returns whether nothing is left to free.
+    bool reclaim() {
+        uint64_t oldest = IDLE;
+        for (size_type i = 0; i < slotCount; i++) {
+            oldest = std::min(oldest, slots[i].epoch.load(std::memory_order_seq_cst));
+        }
+
+        Version** link = &retired;
+        while (*link && (*link)->epoch >= oldest) {
+            link = &(*link)->next;
+        }
+
+        Version* it = *link;
+        *link = nullptr;
+        while (it) {
+            Version* next = it->next;
+            delete it;
+            it = next;
+        }
+        return retired == nullptr;
+    }
+};
@@ -0,0 +1,103 @@
+#include "ThreadPool.hpp"
+
+namespace {
+    // Pool and queue index of the worker running on this thread (nullptr outside of workers).
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local std::size_t currentIndex = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t threads) : queues(threads == 0 ? 1 : threads) {
+    workers.reserve(queues.size() - 1);
+    for (std::size_t i = 1; i < queues.size(); i++) {
+        workers.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCondition.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(task_type task) {
+    Queue& queue = queues[current_index()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    sleepCondition.notify_one();
+}
+
+bool ThreadPool::run_pending_task() {
+    std::size_t index = current_index();
+    task_type task;
+    if (pop(index, task) || steal(index, task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::work(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        task_type task;
+        if (pop(index, task) || steal(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this] {
+            return stopping || queued.load(std::memory_order_acquire) != 0;
+        });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+// Takes the most recently pushed task of the own queue (it is the most likely to be in cache).
+bool ThreadPool::pop(std::size_t index, task_type& task) {
+    Queue& queue = queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Takes the oldest task of another queue, starting with the neighbour to spread the victims.
+bool ThreadPool::steal(std::size_t index, task_type& task) {
+    for (std::size_t i = 1; i < queues.size(); i++) {
+        Queue& queue = queues[(index + i) % queues.size()];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+std::size_t ThreadPool::current_index() const noexcept {
+    return currentPool == this ? currentIndex : 0;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Size of a cache line, used to keep per-thread data from sharing lines (false sharing).
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Work-stealing thread pool.
+// Every participant owns a task queue. A worker pops tasks from the back of its own queue
+// and, when it runs dry, steals from the front of the other queues.
+// The thread that submits work is participant 0: it does not sleep while waiting, but helps
+// by running queued tasks (see TaskGroup::wait()).
+class ThreadPool {
+public:
+    typedef std::function<void()> task_type;
+
+    // Constructs a pool with `threads` participants (the calling thread included),
+    // i.e. `threads - 1` worker threads are started.
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+
+    // Stops and joins all worker threads. Tasks that were not started are dropped.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of participants (worker threads + the calling thread).
+    std::size_t size() const noexcept {
+        return queues.size();
+    }
+
+    // Queues a task. Called from a worker, the task goes to that worker's own queue,
+    // otherwise to the queue of participant 0.
+    void submit(task_type task);
+
+    // Runs one queued task on the calling thread, if there is any.
+    // Returns whether a task was run.
+    bool run_pending_task();
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Queue {
+        std::mutex mutex;
+        std::deque<task_type> tasks;
+    };
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> queued{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopping = false;
+
+    void work(std::size_t index);
+    bool pop(std::size_t index, task_type& task);
+    bool steal(std::size_t index, task_type& task);
+    std::size_t current_index() const noexcept;
+};
+
+// Group of tasks that are waited for together.
+// wait() runs queued tasks on the calling thread until every task of the group is finished
+// and rethrows the first exception thrown by any of them.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+    ~TaskGroup() {
+        finish();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template<class F>
+    void run(F&& f) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            pool.submit([this, f = std::forward<F>(f)]() mutable {
+                try {
+                    f();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        catch (...) {
+            // The task was never queued, so wait() must not wait for it.
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+    }
+
+    void wait() {
+        finish();
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<std::size_t> pending{ 0 };
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void finish() {
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (!pool.run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
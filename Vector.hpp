@@ -247,13 +247,27 @@ public:
     }
 
     // Shrink to fit
-    // Requests the container to reduce its capacity to fit its size.
+    // Reduces the capacity to the size, reallocating the storage so that the memory is returned.
     void shrink_to_fit() {
         if (limit > available) {
-            limit = available;
+            reallocate(size());
         }
     }
 
+    // Automatic shrink policy
+    // When enabled, pop_back() and erase() halve the capacity while the size is at most a quarter of it.
+    // The gap between the shrink (1/4) and grow (full) points keeps a size that oscillates around
+    // a boundary from reallocating on every call. Capacities up to SHRINK_MIN_CAPACITY are kept.
+    // Disabled by default. The setting belongs to the object: copies, moves, assignments and swap
+    // never transfer it.
+    void set_auto_shrink(bool enable) noexcept {
+        autoShrink = enable;
+    }
+
+    bool auto_shrink() const noexcept {
+        return autoShrink;
+    }
+
 
 
     // ELEMENT ACCESS
@@ -369,6 +383,7 @@ public:
         iterator new_available = available;
         alloc.destroy(--new_available);
         available = new_available;
+        shrink_if_sparse();
     }
 
     // Insert elements
@@ -411,15 +426,18 @@ public:
             throw std::out_of_range("Index out of range");
         }
 
+        size_type index = position - data;
         iterator new_available = std::uninitialized_copy(position + 1, available, position);
-        alloc.destroy(available + 1);
+        alloc.destroy(new_available);
 
         available = new_available;
+        shrink_if_sparse();
 
-        return position;
+        return data + index;
     }
 
     iterator erase(iterator first, iterator last) {
+        size_type index = first - data;
         iterator new_available = std::uninitialized_copy(last, available, first);
 
         iterator it = available;
@@ -428,7 +446,8 @@ public:
         }
 
         available = new_available;
-        return last;
+        shrink_if_sparse();
+        return data + index;
     }
 
     // Swap content
@@ -442,8 +461,13 @@ public:
 
     // Clear content
     // Removes all elements from the vector (which are destroyed), leaving the container with a size of 0.
+    // The capacity is kept, so refilling the vector does not reallocate; call shrink_to_fit() to free it.
     void clear() noexcept {
-        destroy();
+        iterator it = available;
+        while (it != data) {
+            alloc.destroy(--it);
+        }
+        available = data;
     }
 
 
@@ -484,11 +508,15 @@ public:
         std::swap(x, y);
     }
 
+    // Capacities up to this one are never reduced by the automatic shrink policy.
+    static constexpr size_type SHRINK_MIN_CAPACITY = 16;
+
 private:
     iterator data; // pirmasis elementas
     iterator available; // pirmasis elementas po paskutinio sukonstruoto elemento
     iterator limit; // pirmasis elementas po paskutinės rezervuotos vietos
     std::allocator<T> alloc;
+    bool autoShrink = false; // automatinis talpos mažinimas (pop_back, erase)
 
     void create() {
         data = available = limit = nullptr;
@@ -517,15 +545,34 @@ private:
     }
 
     void grow(size_type new_capacity = 1) {
-        size_type new_size = std::max(2 * capacity(), new_capacity);
-        iterator new_data = alloc.allocate(new_size);
+        reallocate(std::max(2 * capacity(), new_capacity));
+    }
+
+    // Moves the elements to new storage of exactly new_capacity (>= size()) elements.
+    void reallocate(size_type new_capacity) {
+        iterator new_data = new_capacity ? alloc.allocate(new_capacity) : nullptr;
         iterator new_available = std::uninitialized_copy(data, available, new_data);
 
         destroy();
 
         data = new_data;
         available = new_available;
-        limit = new_data + new_size;
+        limit = new_data + new_capacity;
+    }
+
+    // Halves the capacity as many times as needed (a bulk erase may need several) and reallocates once.
+    void shrink_if_sparse() {
+        if (!autoShrink) {
+            return;
+        }
+
+        size_type new_capacity = capacity();
+        while (new_capacity > SHRINK_MIN_CAPACITY && size() <= new_capacity / 4) {
+            new_capacity /= 2;
+        }
+        if (new_capacity != capacity()) {
+            reallocate(new_capacity);
+        }
     }
 
     void unchecked_append(const T& value) {
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ThreadPool.hpp"
+#include "Vector.hpp"
+
+// Fast ingestion of whitespace separated numbers (e.g. a numeric column, one value per line)
+// from a memory buffer, a file descriptor (file or pipe) or a file into Vector<T>.
+// Values are parsed with std::from_chars and the vector is pre-sized from the input size.
+// Invalid input throws std::invalid_argument, I/O failures throw std::runtime_error.
+namespace ingest {
+
+    // Size of one read() when streaming from a file descriptor.
+    constexpr std::size_t BLOCK_SIZE = 1 << 20;
+
+    // Amount of input sampled to estimate the number of values.
+    constexpr std::size_t SAMPLE_SIZE = 64 * 1024;
+
+    namespace detail {
+
+        inline bool is_space(char c) noexcept {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+        }
+
+        // Estimates the number of values in `size` bytes of input from the values in the sample.
+        inline std::size_t estimate_count(const char* first, const char* last, std::size_t size) {
+            std::size_t values = 0;
+            bool inValue = false;
+            for (const char* it = first; it != last; it++) {
+                bool space = is_space(*it);
+                if (!space && !inValue) {
+                    values++;
+                }
+                inValue = !space;
+            }
+            if (values == 0) {
+                return 0;
+            }
+            std::size_t sampled = last - first;
+            return size / sampled * values + (size % sampled) * values / sampled + 1;
+        }
+
+        // Returns a pointer past the last separator of [first, last) (or first, if there is none).
+        inline const char* last_complete(const char* first, const char* last) {
+            while (last != first && !is_space(*(last - 1))) {
+                last--;
+            }
+            return last;
+        }
+
+        // Returns a pointer past the first newline at or after `it` (or last, if there is none).
+        inline const char* next_line(const char* it, const char* last) {
+            while (it != last && *it != '\n') {
+                it++;
+            }
+            return it == last ? last : it + 1;
+        }
+
+        template<class T>
+        void reserve_for(Vector<T>& out, const char* first, const char* last, std::size_t size) {
+            const char* sampleLast = first + std::min<std::size_t>(SAMPLE_SIZE, last - first);
+            out.reserve(out.size() + estimate_count(first, sampleLast, size));
+        }
+    }
+
+    // Parse
+    // Appends every value of [first, last) to out. Returns the number of values appended.
+    template<class T>
+    std::size_t parse(const char* first, const char* last, Vector<T>& out) {
+        static_assert(std::is_arithmetic<T>::value, "ingest supports integral and floating point types");
+
+        std::size_t count = 0;
+        while (true) {
+            while (first != last && detail::is_space(*first)) {
+                first++;
+            }
+            if (first == last) {
+                return count;
+            }
+
+            T value;
+            std::from_chars_result result = std::from_chars(first, last, value);
+            if (result.ec != std::errc() || (result.ptr != last && !detail::is_space(*result.ptr))) {
+                const char* end = first;
+                while (end != last && !detail::is_space(*end)) {
+                    end++;
+                }
+                throw std::invalid_argument("Invalid number in input: " + std::string(first, end));
+            }
+
+            out.push_back(value);
+            count++;
+            first = result.ptr;
+        }
+    }
+
+    // 1. Buffer
+    // Replaces the contents of out with the values of [first, last).
+    template<class T>
+    void from_buffer(const char* first, const char* last, Vector<T>& out) {
+        out.clear();
+        detail::reserve_for(out, first, last, last - first);
+        parse(first, last, out);
+    }
+
+    // 2. Buffer, multi-threaded
+    // Splits [first, last) on line boundaries and parses the chunks in parallel.
+    // Values spanning several lines are not supported in this mode.
+    template<class T>
+    void from_buffer(ThreadPool& pool, const char* first, const char* last, Vector<T>& out) {
+        std::size_t chunks = std::min<std::size_t>(pool.size() * 4, (last - first) / BLOCK_SIZE + 1);
+        if (chunks <= 1) {
+            from_buffer(first, last, out);
+            return;
+        }
+
+        Vector<const char*> bounds(chunks + 1, last);
+        bounds[0] = first;
+        for (std::size_t k = 1; k < chunks; k++) {
+            const char* candidate = std::max(bounds[k - 1], first + (last - first) / chunks * k);
+            bounds[k] = detail::next_line(candidate, last);
+        }
+
+        Vector<Vector<T>> parts(chunks, Vector<T>());
+        {
+            TaskGroup group(pool);
+            for (std::size_t k = 0; k < chunks; k++) {
+                group.run([&bounds, &parts, k] {
+                    detail::reserve_for(parts[k], bounds[k], bounds[k + 1], bounds[k + 1] - bounds[k]);
+                    parse(bounds[k], bounds[k + 1], parts[k]);
+                });
+            }
+            group.wait();
+        }
+
+        std::size_t total = 0;
+        for (const Vector<T>& part : parts) {
+            total += part.size();
+        }
+
+        out.clear();
+        out.resize(total);
+        TaskGroup group(pool);
+        T* destination = out._data();
+        for (std::size_t k = 0; k < chunks; k++) {
+            group.run([&parts, destination, k] {
+                std::copy(parts[k].begin(), parts[k].end(), destination);
+            });
+            destination += parts[k].size();
+        }
+        group.wait();
+    }
+
+    // 3. File descriptor
+    // Replaces the contents of out with the values read from fd until end of input.
+    // Works with pipes; for regular files the vector is pre-sized from the file size.
+    template<class T>
+    void from_fd(int fd, Vector<T>& out) {
+        out.clear();
+
+        Vector<char> buffer(BLOCK_SIZE);
+        std::size_t kept = 0;
+        bool sized = false;
+
+        while (true) {
+#ifdef _WIN32
+            long got = _read(fd, buffer._data() + kept, unsigned(buffer.size() - kept));
+#else
+            ssize_t got = read(fd, buffer._data() + kept, buffer.size() - kept);
+#endif
+            if (got < 0 && errno == EINTR) {
+                continue; // interrupted by a signal before any data was read
+            }
+            if (got < 0) {
+                throw std::runtime_error("Failed to read input");
+            }
+
+            const char* first = buffer._data();
+            const char* last = first + kept + got;
+            if (got == 0) {
+                parse(first, last, out);
+                return;
+            }
+
+            if (!sized) {
+                struct stat info;
+                if (fstat(fd, &info) == 0 && (info.st_mode & S_IFMT) == S_IFREG) {
+                    detail::reserve_for(out, first, last, std::size_t(info.st_size));
+                }
+                sized = true;
+            }
+
+            const char* complete = detail::last_complete(first, last);
+            if (complete == first && last == first + buffer.size()) {
+                throw std::invalid_argument("Value longer than the read block");
+            }
+            parse(first, complete, out);
+
+            kept = last - complete;
+            std::copy(complete, last, buffer._data());
+        }
+    }
+
+    namespace detail {
+
+        // Read-only view of a whole file: mapped where mmap is available, read into memory otherwise.
+        class FileView {
+        public:
+            explicit FileView(const std::string& path) {
+#ifdef _WIN32
+                int fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+                int fd = open(path.c_str(), O_RDONLY);
+#endif
+                if (fd < 0) {
+                    throw std::runtime_error("Failed to open " + path);
+                }
+
+                struct stat info;
+                if (fstat(fd, &info) != 0) {
+                    close_fd(fd);
+                    throw std::runtime_error("Failed to stat " + path);
+                }
+                size = std::size_t(info.st_size);
+
+#ifdef _WIN32
+                buffer.resize(size);
+                std::size_t done = 0;
+                while (done < size) {
+                    int got = _read(fd, buffer._data() + done, unsigned(std::min<std::size_t>(size - done, 1u << 30)));
+                    if (got <= 0) {
+                        close_fd(fd);
+                        throw std::runtime_error("Failed to read " + path);
+                    }
+                    done += got;
+                }
+                first = buffer._data();
+#else
+                if (size != 0) {
+                    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapped == MAP_FAILED) {
+                        close_fd(fd);
+                        throw std::runtime_error("Failed to map " + path);
+                    }
+                    madvise(mapped, size, MADV_SEQUENTIAL);
+                    first = static_cast<const char*>(mapped);
+                }
+#endif
+                close_fd(fd);
+            }
+
+            ~FileView() {
+#ifndef _WIN32
+                if (first) {
+                    munmap(const_cast<char*>(first), size);
+                }
+#endif
+            }
+
+            FileView(const FileView&) = delete;
+            FileView& operator=(const FileView&) = delete;
+
+            const char* begin() const noexcept {
+                return first;
+            }
+
+            const char* end() const noexcept {
+                return first + size;
+            }
+
+        private:
+            const char* first = nullptr;
+            std::size_t size = 0;
+#ifdef _WIN32
+            Vector<char> buffer;
+#endif
+
+            static void close_fd(int fd) {
+#ifdef _WIN32
+                _close(fd);
+#else
+                close(fd);
+#endif
+            }
+        };
+    }
+
+    // 4. File
+    // Replaces the contents of out with the values of the file at path.
+    template<class T>
+    void from_file(const std::string& path, Vector<T>& out) {
+        detail::FileView file(path);
+        from_buffer(file.begin(), file.end(), out);
+    }
+
+    // 5. File, multi-threaded
+    template<class T>
+    void from_file(ThreadPool& pool, const std::string& path, Vector<T>& out) {
+        detail::FileView file(path);
+        from_buffer(pool, file.begin(), file.end(), out);
+    }
+}
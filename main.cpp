@@ -1,9 +1,28 @@
+#include <charconv>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 #include <iomanip>
-
+#include <thread>
+
+// mallinfo2() is available since glibc 2.33.
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define HAS_MALLINFO2
+#endif
+#endif
+
+#include "CompactVector.hpp"
+#include "ParallelAlgorithms.hpp"
+#include "RcuVector.hpp"
+#include "ThreadPool.hpp"
 #include "Timer.hpp"
 #include "Vector.hpp"
+#include "VectorIngest.hpp"
 
 using namespace std;
 
@@ -19,6 +38,26 @@ void testReserve();
 
 void testRelationalOperators();
 
+void testParallelAlgorithms();
+
+void doParallelAlgorithmsTest();
+
+void testIngest();
+
+void doIngestTest();
+
+void testRcuVector();
+
+void doRcuVectorTest();
+
+void testShrink();
+
+void doShrinkPolicyTest();
+
+void testCompactVector();
+
+void doCompactVectorTest();
+
 int main() {
     doPushBackTest();
     testAssign();
@@ -26,6 +65,16 @@ int main() {
     testPopBack();
     testReserve();
     testRelationalOperators();
+    testParallelAlgorithms();
+    doParallelAlgorithmsTest();
+    testIngest();
+    doIngestTest();
+    testRcuVector();
+    doRcuVectorTest();
+    testShrink();
+    doShrinkPolicyTest();
+    testCompactVector();
+    doCompactVectorTest();
 
     return 0;
 }
@@ -196,4 +245,558 @@ void testRelationalOperators() {
     cout << "first <= second: " << std::boolalpha << (first <= second) << " (expected true)" << endl;
     cout << "first >= second: " << std::boolalpha << (first >= second) << " (expected false)" << endl;
     cout << endl;
+}
+
+void testParallelAlgorithms() {
+    cout << "--- parallel algorithms ---" << endl;
+
+    ThreadPool pool(4);
+    Vector<int> values;
+    for (int i = 1; i <= 100000; i++) {
+        values.push_back(i % 10);
+    }
+
+    parallel::parallel_for(pool, values, [](int& value) { value *= 2; });
+
+    Vector<long long> squares;
+    parallel::transform(pool, values, squares, [](int value) { return (long long)value * value; });
+
+    Vector<int> prefix;
+    parallel::inclusive_scan(pool, values, prefix);
+
+    cout << "reduce: " << parallel::reduce(pool, values) << " (expected 900000)" << endl;
+    cout << "transform + reduce: " << parallel::reduce(pool, squares) << " (expected 11400000)" << endl;
+    cout << "inclusive_scan back: " << prefix.back() << " (expected 900000)" << endl;
+    cout << "inclusive_scan [12344]: " << prefix[12344] << " (expected 111090)" << endl;
+    cout << "count_if (value > 10): "
+        << parallel::count_if(pool, values, [](int value) { return value > 10; }) << " (expected 40000)" << endl;
+
+    Vector<string> labels;
+    parallel::transform(pool, values, labels, [](int value) { return "#" + to_string(value); });
+    cout << "transform to string: " << labels.size() << " values, [12344] " << labels[12344]
+        << " (expected 100000 values, [12344] #10)" << endl;
+
+    // Chunk boundaries of an element size that does not divide the cache line.
+    struct Triple {
+        double x, y, z;
+    };
+    Vector<Triple> triples(100000, Triple{ 0, 0, 0 });
+    parallel::detail::Chunks<Triple> chunks(triples._data(), triples.size(), pool.size(), 0);
+    size_t misaligned = 0;
+    for (size_t k = 1; k < chunks.size(); k++) {
+        misaligned += reinterpret_cast<uintptr_t>(triples._data() + chunks.begin(k)) % CACHE_LINE_SIZE != 0;
+    }
+    cout << "24-byte element chunks: " << chunks.size() << ", misaligned boundaries: " << misaligned
+        << " (expected 0)" << endl;
+    cout << endl;
+}
+
+void doParallelAlgorithmsTest() {
+    Timer timer;
+    const size_t size = 100000000;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    Vector<double> values(size);
+    for (size_t i = 0; i < size; i++) {
+        values[i] = double(i % 1000);
+    }
+    // Filled up front, so that the timed transform and inclusive_scan neither allocate nor page fault.
+    Vector<double> output(size, 0.0);
+
+    cout << "--- parallel algorithms test of size " << size << " (hardware threads: " << maxThreads << "):" << endl;
+
+    Vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baseline[5] = { 0, 0, 0, 0, 0 };
+    for (unsigned int threads : threadCounts) {
+        ThreadPool pool(threads);
+        double times[5];
+
+        timer.reset();
+        parallel::parallel_for(pool, values, [](double& value) { value += 1; });
+        times[0] = timer.elapsed();
+
+        timer.reset();
+        parallel::transform(pool, values, output, [](double value) { return value * 0.5; });
+        times[1] = timer.elapsed();
+
+        timer.reset();
+        double sum = parallel::reduce(pool, values);
+        times[2] = timer.elapsed();
+
+        timer.reset();
+        parallel::inclusive_scan(pool, values, output);
+        times[3] = timer.elapsed();
+
+        timer.reset();
+        size_t count = parallel::count_if(pool, values, [](double value) { return value > 500; });
+        times[4] = timer.elapsed();
+
+        if (threads == 1) {
+            std::copy(times, times + 5, baseline);
+        }
+
+        const char* names[5] = { "parallel_for", "transform", "reduce", "inclusive_scan", "count_if" };
+        cout << threads << " thread(s):" << endl;
+        for (int i = 0; i < 5; i++) {
+            cout << "  " << std::left << std::setw(15) << names[i] << std::right
+                << std::fixed << std::setprecision(5) << times[i] << "s. "
+                << "Speedup " << std::setprecision(2) << baseline[i] / times[i] << "x" << endl;
+        }
+        cout << "  (reduce " << std::setprecision(0) << sum << ", scan back " << output.back()
+            << ", count_if " << count << ")" << endl;
+    }
+    cout << endl;
+}
+
+void testIngest() {
+    cout << "--- ingest ---" << endl;
+
+    string text = "1\n-2\n  3\r\n40\t5\n";
+    Vector<int> integers;
+    ingest::from_buffer(text.data(), text.data() + text.size(), integers);
+    int integerSum = 0;
+    for (int value : integers) {
+        integerSum += value;
+    }
+    cout << "from_buffer<int>: " << integers.size() << " values, sum " << integerSum << " (expected 5 values, sum 47)" << endl;
+
+    string floats = "1.5\n2.25\n-0.75\n1e2\n";
+    Vector<double> doubles;
+    ingest::from_buffer(floats.data(), floats.data() + floats.size(), doubles);
+    cout << "from_buffer<double>: " << doubles.size() << " values, last " << doubles.back()
+        << " (expected 4 values, last 100)" << endl;
+
+    string lines;
+    for (int i = 0; i < 1000000; i++) {
+        lines += to_string(i * 7 % 1000003) + "\n";
+    }
+    ThreadPool pool(4);
+    Vector<int> serial;
+    Vector<int> chunked;
+    ingest::from_buffer(lines.data(), lines.data() + lines.size(), serial);
+    ingest::from_buffer(pool, lines.data(), lines.data() + lines.size(), chunked);
+    cout << "multi-threaded from_buffer equals serial: " << std::boolalpha << (serial == chunked)
+        << ", size " << chunked.size() << " (expected true, size 1000000)" << endl;
+
+    string invalid = "1\n2x\n";
+    try {
+        ingest::from_buffer(invalid.data(), invalid.data() + invalid.size(), integers);
+        cout << "invalid input: no exception (expected invalid_argument)" << endl;
+    }
+    catch (const std::invalid_argument& e) {
+        cout << "invalid input: " << e.what() << " (expected Invalid number in input: 2x)" << endl;
+    }
+    cout << endl;
+}
+
+// Writes `bytes` bytes of integers, one per line.
+void writeNumberFile(const string& path, size_t bytes) {
+    ofstream file(path, ios::binary);
+    Vector<char> block(ingest::BLOCK_SIZE);
+    size_t written = 0;
+    unsigned int value = 1;
+    while (written < bytes) {
+        char* it = block._data();
+        char* last = it + block.size() - 16;
+        while (it < last) {
+            value = value * 1103515245u + 12345u;
+            it = std::to_chars(it, it + 16, int(value % 2000000000u) - 1000000000).ptr;
+            *it++ = '\n';
+        }
+        file.write(block._data(), it - block._data());
+        written += it - block._data();
+    }
+}
+
+void doIngestTest() {
+    Timer timer;
+    const string path = "ingest_test.txt";
+    const size_t megabyte = 1 << 20;
+    vector<size_t> sizes = { 256 * megabyte, 1024 * megabyte, 2048 * megabyte };
+    ThreadPool pool;
+
+    for (auto size : sizes) {
+        writeNumberFile(path, size);
+        double megabytes = double(size) / megabyte;
+        cout << "--- ingest test of " << size / megabyte << " MB:" << endl;
+
+        Vector<int> values;
+        double elapsed;
+
+        if (size == sizes.front()) {
+            ifstream stream(path);
+            int value;
+            timer.reset();
+            while (stream >> value) {
+                values.push_back(value);
+            }
+            elapsed = timer.elapsed();
+            cout << "istream >> push_back: " << std::fixed << std::setprecision(5) << elapsed << "s. "
+                << std::setprecision(1) << megabytes / elapsed << " MB/s" << endl;
+            values.clear();
+        }
+
+        int fd = open(path.c_str(), O_RDONLY);
+        timer.reset();
+        ingest::from_fd(fd, values);
+        elapsed = timer.elapsed();
+        close(fd);
+        cout << "ingest::from_fd: " << std::fixed << std::setprecision(5) << elapsed << "s. "
+            << std::setprecision(1) << megabytes / elapsed << " MB/s" << endl;
+
+        timer.reset();
+        ingest::from_file(path, values);
+        elapsed = timer.elapsed();
+        cout << "ingest::from_file: " << std::fixed << std::setprecision(5) << elapsed << "s. "
+            << std::setprecision(1) << megabytes / elapsed << " MB/s" << endl;
+
+        timer.reset();
+        ingest::from_file(pool, path, values);
+        elapsed = timer.elapsed();
+        cout << "ingest::from_file (" << pool.size() << " threads): " << std::fixed << std::setprecision(5) << elapsed << "s. "
+            << std::setprecision(1) << megabytes / elapsed << " MB/s, " << values.size() << " values" << endl;
+
+        cout << endl;
+    }
+
+    std::remove(path.c_str());
+}
+
+void testRcuVector() {
+    cout << "--- RcuVector ---" << endl;
+
+    RcuVector<int> table({ 1, 2, 3 });
+    RcuVector<int>::Reader reader = table.reader();
+    {
+        RcuVector<int>::Snapshot before = reader.read();
+        table.update([](Vector<int>& next) {
+            next.push_back(4);
+            next[0] = 10;
+        });
+
+        RcuVector<int>::Snapshot nested = reader.read();
+        cout << "Old snapshot size: " << before.size() << ", first " << before[0]
+            << ", nested snapshot size: " << nested.size() << " (expected 3, first 1, nested 3)" << endl;
+        cout << "Retired versions while read: " << table.retired_count() << " (expected 1)" << endl;
+    }
+
+    RcuVector<int>::Snapshot after = reader.read();
+    cout << "New snapshot: ";
+    for (int value : after) {
+        cout << value << ", ";
+    }
+    cout << "(expected 10, 2, 3, 4)" << endl;
+
+    table.synchronize();
+    cout << "Retired versions after synchronize: " << table.retired_count() << " (expected 0)" << endl;
+    cout << endl;
+}
+
+void doRcuVectorTest() {
+    const size_t size = 1000;
+    const int readerCount = 4;
+    const double duration = 1.0;
+
+    cout << "--- RcuVector vs shared_mutex test (" << readerCount << " readers, 1 writer, "
+        << size << " elements, " << duration << "s):" << endl;
+
+    // Every reader sums elements of the table until the time is up, the writer keeps changing it.
+    auto run = [&](auto read, auto write) {
+        std::atomic<bool> done(false);
+        std::atomic<unsigned long long> reads(0);
+        unsigned long long writes = 0;
+
+        Vector<std::thread*> readers;
+        for (int r = 0; r < readerCount; r++) {
+            readers.push_back(new std::thread([&, r] {
+                unsigned long long count = 0;
+                size_t index = r;
+                long long sum = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    sum += read(index);
+                    index = (index + 7) % size;
+                    count++;
+                }
+                reads += count + (sum == 42 ? 1 : 0);
+            }));
+        }
+
+        Timer timer;
+        timer.reset();
+        while (timer.elapsed() < duration) {
+            write(writes++ % size);
+        }
+        done = true;
+        for (std::thread* thread : readers) {
+            thread->join();
+            delete thread;
+        }
+
+        cout << std::fixed << std::setprecision(1) << reads / duration / 1e6 << " M reads/s, "
+            << writes / duration / 1e3 << " K writes/s" << endl;
+    };
+
+    Vector<int> initial(size, 1);
+
+    RcuVector<int> rcu(initial);
+    cout << "RcuVector: ";
+    run([&](size_t index) {
+        thread_local RcuVector<int>::Reader reader = rcu.reader();
+        return reader.read()[index];
+    }, [&](size_t index) {
+        rcu.update([index](Vector<int>& next) { next[index]++; });
+    });
+
+    Vector<int> locked(initial);
+    std::shared_mutex mutex;
+    cout << "shared_mutex + Vector: ";
+    run([&](size_t index) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return locked[index];
+    }, [&](size_t index) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        locked[index]++;
+    });
+    cout << endl;
+}
+
+void testShrink() {
+    cout << "--- Vector::shrink_to_fit, Vector::clear, auto shrink ---" << endl;
+
+    Vector<int> array;
+    for (int i = 0; i < 100; i++) {
+        array.push_back(i);
+    }
+    array.clear();
+    cout << "After clear(): size " << array.size() << ", capacity " << array.capacity() << " (expected 0, 128)" << endl;
+
+    array.push_back(1);
+    array.shrink_to_fit();
+    cout << "After shrink_to_fit(): size " << array.size() << ", capacity " << array.capacity() << " (expected 1, 1)" << endl;
+
+    Vector<int> shrinking;
+    shrinking.set_auto_shrink(true);
+    for (int i = 0; i < 128; i++) {
+        shrinking.push_back(i);
+    }
+
+    Vector<int> capacityChanges;
+    Vector<int>::size_type capacity = shrinking.capacity();
+    while (!shrinking.empty()) {
+        shrinking.pop_back();
+        if (capacity != shrinking.capacity()) {
+            capacity = shrinking.capacity();
+            capacityChanges.push_back(capacity);
+        }
+    }
+    cout << "Auto shrink capacity changes on pop_back: ";
+    for (int value : capacityChanges) {
+        cout << value << ", ";
+    }
+    cout << "(expected 64, 32, 16)" << endl;
+
+    for (int i = 0; i < 64; i++) {
+        shrinking.push_back(i);
+    }
+    Vector<int>::iterator next = shrinking.erase(shrinking.begin() + 8, shrinking.begin() + 56);
+    cout << "Auto shrink after erase: size " << shrinking.size() << ", capacity " << shrinking.capacity()
+        << ", returned index " << (next - shrinking.begin()) << ", value " << *next
+        << " (expected 16, 32, 8, 56)" << endl;
+
+    Vector<int> bulk;
+    bulk.set_auto_shrink(true);
+    for (int i = 0; i < 1000; i++) {
+        bulk.push_back(i);
+    }
+    bulk.erase(bulk.begin() + 2, bulk.end() - 2);
+    cout << "Auto shrink after bulk erase: size " << bulk.size() << ", capacity " << bulk.capacity()
+        << " (expected 4, 16)" << endl;
+
+    Vector<int> copy(shrinking);
+    Vector<int> assigned;
+    assigned = shrinking;
+    cout << "Auto shrink of copy and assigned: " << std::boolalpha << copy.auto_shrink() << ", "
+        << assigned.auto_shrink() << " (expected false, false)" << endl;
+    cout << endl;
+}
+
+// Resident set size of the process in MB (0 where /proc is not available).
+double residentMegabytes() {
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * 4096.0 / (1 << 20);
+}
+
+void doShrinkPolicyTest() {
+    Timer timer;
+    const int cycles = 8;
+    const int peak = 50000000;
+    const int trough = 1000;
+
+    cout << "--- bursty workload test (" << cycles << " bursts of up to " << peak << " elements):" << endl;
+
+    const char* names[3] = { "keep capacity", "clear + shrink_to_fit", "auto shrink" };
+    for (int mode = 0; mode < 3; mode++) {
+        Vector<int> array;
+        array.set_auto_shrink(mode == 2);
+        Vector<int>::size_type capacity = array.capacity();
+        int reallocations = 0;
+        unsigned int random = 1;
+
+        cout << names[mode] << " (RSS before " << std::fixed << std::setprecision(1) << residentMegabytes() << " MB):" << endl;
+        timer.reset();
+        for (int cycle = 0; cycle < cycles; cycle++) {
+            random = random * 1103515245u + 12345u;
+            int burst = peak / 2 + int(random % (peak / 2));
+            for (int i = 0; i < burst; i++) {
+                array.push_back(i);
+                if (capacity != array.capacity()) {
+                    capacity = array.capacity();
+                    reallocations++;
+                }
+            }
+            double peakRss = residentMegabytes();
+
+            while (int(array.size()) > trough) {
+                array.pop_back();
+                if (capacity != array.capacity()) {
+                    capacity = array.capacity();
+                    reallocations++;
+                }
+            }
+            if (mode == 1) {
+                array.shrink_to_fit();
+                if (capacity != array.capacity()) {
+                    capacity = array.capacity();
+                    reallocations++;
+                }
+            }
+
+            cout << "  burst " << cycle + 1 << ": " << std::setw(8) << burst << " elements, RSS peak "
+                << std::fixed << std::setprecision(1) << peakRss << " MB, trough " << residentMegabytes()
+                << " MB, reallocations " << reallocations << endl;
+        }
+        cout << "  time " << std::setprecision(5) << timer.elapsed() << "s." << endl;
+    }
+    cout << endl;
+}
+
+void testCompactVector() {
+    cout << "--- CompactVector ---" << endl;
+
+    cout << "sizeof: Vector<int> " << sizeof(Vector<int>) << ", CompactVector<int, false> " << sizeof(CompactVector<int, false>)
+        << ", CompactVector<int> " << sizeof(CompactVector<int>) << " (expected 32, 16, 8 on 64-bit)" << endl;
+
+    CompactVector<int> array(3, 1);
+    CompactVector<int>::iterator it = array.begin();
+    it = array.insert(it, 2);
+    array.insert(it, 2, 3);
+    array.push_back(4);
+    array.erase(array.begin() + 1);
+
+    cout << "CompactVector contains: ";
+    for (int value : array) {
+        cout << value << ", ";
+    }
+    cout << "(expected 3, 2, 1, 1, 1, 4)" << endl;
+
+    CompactVector<int, false> first = { 1, 1, 1 };
+    CompactVector<int, false> second = { 2, 2 };
+    CompactVector<int, false> moved(std::move(second));
+    cout << "first < moved: " << std::boolalpha << (first < moved) << ", moved size " << moved.size()
+        << ", source size " << second.size() << " (expected true, 2, 0)" << endl;
+
+    CompactVector<int> aliased;
+    aliased.push_back(7);
+    aliased.push_back(8);
+    aliased.push_back(aliased[0]);
+    CompactVector<int> filled = { 0, 1, 2, 3, 4 };
+    filled.reserve(8);
+    filled.insert(filled.begin(), 3, filled[4]);
+    cout << "push_back(own element) when full: " << aliased.back() << ", insert(own element): ";
+    for (int value : filled) {
+        cout << value << ", ";
+    }
+    cout << "(expected 7, 4, 4, 4, 0, 1, 2, 3, 4)" << endl;
+
+    CompactVector<string, false> words = { "alpha", "beta" };
+    words.shrink_to_fit();
+    words.resize(10, words[0]);
+    CompactVector<string> refilled = { "gamma", "delta" };
+    refilled.assign(3, refilled[1]);
+    cout << "resize(own element): " << words.size() << " x " << words[9] << ", assign(own element): "
+        << refilled.size() << " x " << refilled[2] << " (expected 10 x alpha, 3 x delta)" << endl;
+
+    CompactVector<int> copied(array);
+    cout << "Copy of " << array.size() << " elements: capacity " << copied.capacity() << " (expected 6)" << endl;
+
+    array.clear();
+    cout << "After clear(): capacity " << array.capacity();
+    array.shrink_to_fit();
+    cout << ", after shrink_to_fit(): capacity " << array.capacity() << " (expected 12, 0)" << endl;
+    cout << endl;
+}
+
+// Heap memory in use in MB, including the allocator's per-block overhead (RSS without glibc 2.33+).
+double heapMegabytes() {
+#ifdef HAS_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    return (info.uordblks + info.hblkhd) / double(1 << 20);
+#else
+    return residentMegabytes();
+#endif
+}
+
+// Builds an adjacency list of `vertices` vertices with 1-8 neighbours each and sums all neighbours.
+template<class Adjacency>
+void doAdjacencyTest(const char* name, size_t vertices) {
+    Timer timer;
+    double before = heapMegabytes();
+
+    timer.reset();
+    vector<Adjacency> graph(vertices);
+    unsigned int random = 1;
+    for (size_t v = 0; v < vertices; v++) {
+        random = random * 1103515245u + 12345u;
+        int degree = 1 + (random >> 16) % 8;
+        for (int d = 0; d < degree; d++) {
+            random = random * 1103515245u + 12345u;
+            graph[v].push_back(int((random >> 8) % vertices));
+        }
+    }
+    double build = timer.elapsed();
+    double memory = heapMegabytes() - before;
+
+    timer.reset();
+    long long sum = 0;
+    for (int pass = 0; pass < 5; pass++) {
+        for (const Adjacency& neighbours : graph) {
+            for (int neighbour : neighbours) {
+                sum += neighbour;
+            }
+        }
+    }
+    double traversal = timer.elapsed() / 5;
+
+    cout << std::left << std::setw(27) << name << std::right << " header " << std::setw(2) << sizeof(Adjacency)
+        << " B, memory " << std::fixed << std::setprecision(1) << std::setw(7) << memory << " MB, build "
+        << std::setprecision(5) << build << "s, traversal " << traversal << "s (sum " << sum << ")" << endl;
+}
+
+void doCompactVectorTest() {
+    const size_t vertices = 10000000;
+    cout << "--- adjacency list test (" << vertices << " vertices, 1-8 neighbours):" << endl;
+
+    doAdjacencyTest<Vector<int>>("Vector<int>", vertices);
+    doAdjacencyTest<CompactVector<int, false>>("CompactVector<int, false>", vertices);
+    doAdjacencyTest<CompactVector<int>>("CompactVector<int>", vertices);
+    doAdjacencyTest<vector<int>>("std::vector<int>", vertices);
+    cout << endl;
 }
\ No newline at end of file